@@ -0,0 +1,171 @@
+/** \file Topology.h
+ *  Date Created: October 19th, 2026
+ *
+ *  Network topologies beyond the 3D torus of TopoManager. A topology is
+ *  described in a plain text config file, one "key value ..." per line and
+ *  '#' for comments:
+ *
+ *    topology torus | mesh	dims X Y Z ...	[wrap 1 1 0 ...]
+ *    topology dragonfly	groups G  routers A  nodes P  globals H
+ *    topology fattree		pods P  switches E  nodes N
+ *    topology topomgr		(TopoManager, needs USE_TOPOMGR)
+ *
+ *  Nodes are numbered group-major (torus: x fastest; dragonfly: group,
+ *  router, port; fat-tree: pod, edge switch, port). "host <name> <node>"
+ *  lines pin hosts to nodes. Without them the nodes of the allocation are
+ *  numbered in the order of their leader ranks, which has nothing to do with
+ *  where they sit in a dragonfly or fat-tree, so mapRanks warns and the hop
+ *  distances (and the pairings built on them) are only meaningful once the
+ *  hosts are pinned.
+ *
+ *  Hops count the switch-to-switch (or router-to-router) links on a minimal
+ *  route, so ranks on the same node or under the same switch are 0 hops
+ *  apart.
+ */
+
+#ifndef _TOPOLOGY_H_
+#define _TOPOLOGY_H_
+
+#include <mpi.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// Pairings that can be built against any topology
+#define PATTERN_INTRA_GROUP	0
+#define PATTERN_CROSS_GROUP	1
+#define PATTERN_ADVERSARIAL	2
+#define NUM_PATTERNS		3
+
+/* Partner of i in round r of a round-robin tournament among n players
+ * (circle method), or -1 if i sits out the round. There are n-1 rounds for
+ * even n and n rounds for odd n.
+ */
+int round_robin_partner(int n, int r, int i);
+int round_robin_rounds(int n);
+
+class Topology {
+  public:
+    /* Reads a topology config file. Returns NULL (after printing the reason)
+     * if the file cannot be read or describes an invalid topology.
+     */
+    static Topology *load(const char *file);
+
+    virtual ~Topology() {}
+
+    virtual const char *getName() const = 0;
+    virtual int getNumNodes() const = 0;
+    virtual int getHopsBetweenNodes(int n1, int n2) const = 0;
+
+    // dragonfly groups, fat-tree pods, a torus is a single group
+    virtual const char *getGroupName() const { return "group"; }
+    virtual int getNumGroups() const { return 1; }
+    virtual int getNodesPerGroup() const { return getNumNodes(); }
+    int getGroupOfNode(int node) const { return node / getNodesPerGroup(); }
+
+    /* Places the ranks of comm on nodes, collective over comm. Has to be
+     * called before any of the rank queries below.
+     */
+    virtual void mapRanks(MPI_Comm comm);
+
+    // whether nodes numbered in allocation order are good enough
+    virtual bool orderedPlacement() const { return false; }
+
+    int getNumRanks() const { return nodeOfRank.size(); }
+    int getNodeOfRank(int rank) const { return nodeOfRank[rank]; }
+    int getHopsBetweenRanks(int r1, int r2) const {
+      return getHopsBetweenNodes(nodeOfRank[r1], nodeOfRank[r2]);
+    }
+
+    /* Fills map with the partner of every rank (-1 for idle ranks) under one
+     * of the PATTERN_* pairings. Returns 0 if the pattern does not apply to
+     * this topology. The map is symmetric: map[map[i]] == i.
+     */
+    int buildPatternMap(int pattern, int *map) const;
+    void getPatternName(int pattern, char *name) const;
+
+  protected:
+    // fills nodeOfRank and localOfRank without checking the node numbers
+    void assignNodes(MPI_Comm comm);
+
+    // partner node under a pattern, -1 if the node is idle
+    int patternPartner(int pattern, int node) const;
+
+    std::map<std::string, int> hostToNode;
+    std::vector<int> nodeOfRank;
+    std::vector<int> localOfRank;
+};
+
+class TorusTopology : public Topology {
+  public:
+    TorusTopology(const std::vector<int> &dims, const std::vector<int> &wrap);
+
+    const char *getName() const { return torus ? "torus" : "mesh"; }
+    bool orderedPlacement() const { return true; }
+    int getNumNodes() const { return numNodes; }
+    int getHopsBetweenNodes(int n1, int n2) const;
+
+  private:
+    std::vector<int> dims, wrap;
+    int numNodes;
+    bool torus;
+};
+
+class DragonflyTopology : public Topology {
+  public:
+    DragonflyTopology(int groups, int routers, int nodes, int globals);
+
+    const char *getName() const { return "dragonfly"; }
+    int getNumNodes() const { return groups * routers * nodes; }
+    int getHopsBetweenNodes(int n1, int n2) const;
+
+    int getNumGroups() const { return groups; }
+    int getNodesPerGroup() const { return routers * nodes; }
+
+  private:
+    // router in group g that owns the global link to group d
+    int gateway(int g, int d) const;
+
+    int groups, routers, nodes, globals;
+};
+
+class FatTreeTopology : public Topology {
+  public:
+    FatTreeTopology(int pods, int switches, int nodes);
+
+    const char *getName() const { return "fattree"; }
+    int getNumNodes() const { return pods * switches * nodes; }
+    int getHopsBetweenNodes(int n1, int n2) const;
+
+    const char *getGroupName() const { return "pod"; }
+    int getNumGroups() const { return pods; }
+    int getNodesPerGroup() const { return switches * nodes; }
+
+  private:
+    int pods, switches, nodes;
+};
+
+#if USE_TOPOMGR
+class TopoManager;
+
+/* The torus as reported by TopoManager on Blue Gene and Cray XT. Nodes are
+ * the nodes of the allocation, numbered as by mapRanks, which has to be
+ * called on MPI_COMM_WORLD since TopoManager works with world ranks.
+ */
+class TopoMgrTopology : public Topology {
+  public:
+    TopoMgrTopology();
+    ~TopoMgrTopology();
+
+    const char *getName() const { return "topomgr"; }
+    int getNumNodes() const { return firstRank.size(); }
+    int getHopsBetweenNodes(int n1, int n2) const;
+    void mapRanks(MPI_Comm comm);
+
+  private:
+    TopoManager *tmgr;
+    std::vector<int> firstRank;
+};
+#endif
+
+#endif // _TOPOLOGY_H_
@@ -0,0 +1,432 @@
+/** \file aggr.c
+ *  Date Created: October 19th, 2026
+ *
+ *  AGGR Benchmark:
+ *  --------------------------------------------------------------------------
+ *  This benchmark evaluates node-level message aggregation as a mitigation
+ *  for small message contention. Every processor sends NUM_MSGS small
+ *  messages to its partner in the same nearest neighbor or random map as
+ *  wicon.c, in three modes:
+ *    -- direct:  NUM_MSGS separate messages
+ *    -- packed:  each rank packs its NUM_MSGS messages into one
+ *    -- aggr:    the ranks on a node (found through a shared memory
+ *                communicator) hand their packed messages to the node leader,
+ *                which coalesces all of them going to the same destination
+ *                node into one batch, injects the batches and hands the
+ *                incoming ones out to the local ranks
+ *  Packed vs. aggr isolates the effect of node-level coalescing from that of
+ *  packing. All modes run over the same map in every trial.
+ *
+ *  Output (one line per message size, averaged over the trials):
+ *    msg_size direct_avg direct_max packed_avg packed_max aggr_avg aggr_max
+ *    direct_bw packed_bw aggr_bw buffer_delay ranks_per_batch
+ *  where the times are the time for all messages of a rank to arrive, the
+ *  bandwidths are the total bytes delivered per second, the buffering delay
+ *  is the time a message spends in the aggregator before injection and
+ *  ranks_per_batch is the number of distinct source ranks in an inter-node
+ *  batch.
+ */
+
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <malloc.h>
+
+// Minimum message size (bytes)
+#define MIN_MSG_SIZE 4
+
+// Maximum message size (bytes), aggregation only makes sense for small ones
+#define MAX_MSG_SIZE (16 * 1024)
+
+#define NUM_MSGS	10
+#define NUM_TRIALS	10
+
+// Every record carries the source and destination rank ahead of the payload
+#define HDR_SIZE	(2 * sizeof(int))
+
+/* Creating a random map
+ * Code taken from Matt Reilly's benchmark:
+ * http://www.bigncomputing.org/Big_N_Computing/Big_N_Computing/Entries/2008/4/14_High_Processor_Count_Computing.html
+ */
+static int random_ready = 0;
+void init_random()
+{
+  srand48(33550336);
+  random_ready = 1;
+}
+
+double get_random_double()
+{
+  if(random_ready == 0) init_random();
+  return drand48();
+}
+
+int get_random_int(int max)
+{
+  double dr;
+  int res = max;
+  while (res >= max) {
+    dr = get_random_double() * ((double) max);
+    res = (int) floor(dr);
+  }
+  return res;
+}
+
+void dump_map(int size, int * map)
+{
+  int i;
+  for(i = 0; i < size; i++) {
+    printf("map[%03d] = %03d\n", i, map[i]);
+  }
+
+  fflush(stdout);
+}
+
+/* Node layout, set up once in main
+ */
+static MPI_Comm nodecomm, leadercomm;
+static int ppn, noderank, mynode, numnodes;
+static int *nodeOf, *localOf;
+
+#define SHUFFLE_ITERATIONS 4
+
+void build_random_map(int init, int size, int * map)
+{
+#if RANDOMNESS
+  int i, j, k, p, q;
+
+  if(size & 1) {
+    fprintf(stderr, "Random maps must be even length\n");
+    exit(-1);
+  }
+
+  if(init) {
+    // build an initial map that maps all entries K to K + (K mod 2)
+    for(i = 0; i < size; i++) {
+      map[i] = i ^ 1;
+    }
+  }
+
+  // Now do random pair swaps
+  for(j = 0; j < SHUFFLE_ITERATIONS; j++) {
+    for(i = 0; i < size; i++) {
+      // for each mapping entry, pick someone to swap with.
+      k = i;
+      while ((k == i) || (k == map[i])) {
+	k = get_random_int(size);
+      }
+
+      p = map[i];
+      q = map[k];
+
+      map[i] = q;
+      map[p] = k;
+      map[k] = p;
+      map[q] = i;
+    }
+  }
+#else
+  // pair node n with node n^1, rank by rank, using the actual placement
+  int i, maxlocal = 0;
+  int *rankAt;
+
+  for(i = 0; i < size; i++)
+    if(localOf[i] >= maxlocal)
+      maxlocal = localOf[i] + 1;
+  rankAt = (int *) malloc(sizeof(int) * numnodes * maxlocal);
+  for(i = 0; i < numnodes * maxlocal; i++)
+    rankAt[i] = -1;
+  for(i = 0; i < size; i++)
+    rankAt[nodeOf[i] * maxlocal + localOf[i]] = i;
+
+  for(i = 0; i < size; i++) {
+    if((nodeOf[i] ^ 1) >= numnodes ||
+       (map[i] = rankAt[(nodeOf[i] ^ 1) * maxlocal + localOf[i]]) < 0) {
+      fprintf(stderr, "Nearest neighbor maps need an even number of nodes with the same number of ranks\n");
+      exit(-1);
+    }
+  }
+  free(rankAt);
+#endif
+
+  // dump_map(size, map);
+}
+
+// Leader side state for aggregation
+static char *gather_buf, *batch_buf, *inbox_buf, *scatter_buf;
+static int *count, *pos, *peers;
+static MPI_Request *reqs;
+
+double direct_exchange(int myrank, int pe, int msg_size, char *send_buf, char *recv_buf)
+{
+  MPI_Request mreq[2 * NUM_MSGS];
+  double start;
+  int i;
+
+  MPI_Barrier(MPI_COMM_WORLD);
+  start = MPI_Wtime();
+
+  for(i=0; i<NUM_MSGS; i++)
+    MPI_Irecv(recv_buf + i * msg_size, msg_size, MPI_CHAR, pe, i, MPI_COMM_WORLD, &mreq[i]);
+  for(i=0; i<NUM_MSGS; i++)
+    MPI_Isend(send_buf + i * msg_size, msg_size, MPI_CHAR, pe, i, MPI_COMM_WORLD, &mreq[NUM_MSGS + i]);
+  MPI_Waitall(2 * NUM_MSGS, mreq, MPI_STATUSES_IGNORE);
+
+  return MPI_Wtime() - start;
+}
+
+/* Same as direct_exchange with the NUM_MSGS messages packed into one
+ */
+double packed_exchange(int myrank, int pe, int msg_size, char *send_buf, char *recv_buf)
+{
+  MPI_Request mreq[2];
+  double start;
+
+  MPI_Barrier(MPI_COMM_WORLD);
+  start = MPI_Wtime();
+
+  MPI_Irecv(recv_buf, NUM_MSGS * msg_size, MPI_CHAR, pe, 1, MPI_COMM_WORLD, &mreq[0]);
+  MPI_Isend(send_buf, NUM_MSGS * msg_size, MPI_CHAR, pe, 1, MPI_COMM_WORLD, &mreq[1]);
+  MPI_Waitall(2, mreq, MPI_STATUSES_IGNORE);
+
+  return MPI_Wtime() - start;
+}
+
+/* Sends the NUM_MSGS messages in send_rec (header + payload) to pe through
+ * the node leaders. On the leaders, delay is set to the time spent before the
+ * batches were injected and batches to the number of batches sent.
+ */
+double aggregated_exchange(int myrank, int pe, int msg_size, char *send_rec,
+			   char *recv_rec, double *delay, int *batches)
+{
+  int rec_size = HDR_SIZE + NUM_MSGS * msg_size;
+  int i, n, dst, node, npeers = 0, nreqs = 0, off;
+  int *hdr = (int *) send_rec;
+  double start;
+
+  hdr[0] = myrank;
+  hdr[1] = pe;
+
+  MPI_Barrier(MPI_COMM_WORLD);
+  start = MPI_Wtime();
+
+  MPI_Gather(send_rec, rec_size, MPI_BYTE, gather_buf, rec_size, MPI_BYTE, 0, nodecomm);
+
+  if(noderank == 0) {
+    // count the records going to every destination node, records for our
+    // own node go straight to the scatter buffer
+    for(i=0; i<ppn; i++) {
+      dst = ((int *) (gather_buf + i * rec_size))[1];
+      node = nodeOf[dst];
+      if(node == mynode) {
+	memcpy(scatter_buf + localOf[dst] * rec_size, gather_buf + i * rec_size, rec_size);
+      } else {
+	if(count[node] == 0)
+	  peers[npeers++] = node;
+	count[node]++;
+      }
+    }
+
+    // lay the batches out one after the other in the order of peers
+    for(n=0, off=0; n<npeers; n++) {
+      pos[peers[n]] = off;
+      off += count[peers[n]];
+    }
+    for(i=0; i<ppn; i++) {
+      dst = ((int *) (gather_buf + i * rec_size))[1];
+      node = nodeOf[dst];
+      if(node != mynode)
+	memcpy(batch_buf + (pos[node]++) * rec_size, gather_buf + i * rec_size, rec_size);
+    }
+
+    *delay = MPI_Wtime() - start;
+    *batches = npeers;
+
+    // the maps are symmetric, so a peer sends us exactly as many records as
+    // we send to it
+    for(n=0, off=0; n<npeers; n++) {
+      node = peers[n];
+      MPI_Irecv(inbox_buf + off * rec_size, count[node] * rec_size, MPI_BYTE, node, 1, leadercomm, &reqs[nreqs++]);
+      MPI_Isend(batch_buf + off * rec_size, count[node] * rec_size, MPI_BYTE, node, 1, leadercomm, &reqs[nreqs++]);
+      off += count[node];
+      count[node] = 0;
+    }
+    MPI_Waitall(nreqs, reqs, MPI_STATUSES_IGNORE);
+
+    for(i=0; i<off; i++) {
+      dst = ((int *) (inbox_buf + i * rec_size))[1];
+      memcpy(scatter_buf + localOf[dst] * rec_size, inbox_buf + i * rec_size, rec_size);
+    }
+  }
+
+  MPI_Scatter(scatter_buf, rec_size, MPI_BYTE, recv_rec, rec_size, MPI_BYTE, 0, nodecomm);
+
+  return MPI_Wtime() - start;
+}
+
+int main(int argc, char *argv[]) {
+  int numprocs, myrank;
+  MPI_Init(&argc, &argv);
+  MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+
+  double dtime, ptime, atime, delay, avg, max, sum, offnode;
+  double time[11];
+  int msg_size, batches, nbatches;
+  int i=0, pe, trial;
+  char name[30];
+
+  // find the ranks that share our node and number the nodes
+  MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, myrank, MPI_INFO_NULL, &nodecomm);
+  MPI_Comm_size(nodecomm, &ppn);
+  MPI_Comm_rank(nodecomm, &noderank);
+  MPI_Comm_split(MPI_COMM_WORLD, (noderank == 0) ? 0 : MPI_UNDEFINED, myrank, &leadercomm);
+  if(noderank == 0) {
+    MPI_Comm_rank(leadercomm, &mynode);
+    MPI_Comm_size(leadercomm, &numnodes);
+  }
+  MPI_Bcast(&mynode, 1, MPI_INT, 0, nodecomm);
+  MPI_Bcast(&numnodes, 1, MPI_INT, 0, nodecomm);
+
+  int layout[2] = {mynode, noderank};
+  int *layouts = (int *) malloc(sizeof(int) * 2 * numprocs);
+  MPI_Allgather(layout, 2, MPI_INT, layouts, 2, MPI_INT, MPI_COMM_WORLD);
+  nodeOf = (int *) malloc(sizeof(int) * numprocs);
+  localOf = (int *) malloc(sizeof(int) * numprocs);
+  for(i = 0; i < numprocs; i++) {
+    nodeOf[i] = layouts[2*i];
+    localOf[i] = layouts[2*i + 1];
+  }
+  free(layouts);
+
+  int max_rec = HDR_SIZE + NUM_MSGS * MAX_MSG_SIZE;
+  char *send_buf = (char *)memalign(64 * 1024, max_rec);
+  char *recv_buf = (char *)memalign(64 * 1024, max_rec);
+
+  for(i = 0; i < max_rec; i++) {
+    recv_buf[i] = send_buf[i] = (char) (i & 0xff);
+  }
+
+  if(noderank == 0) {
+    gather_buf  = (char *)memalign(64 * 1024, ppn * max_rec);
+    batch_buf   = (char *)memalign(64 * 1024, ppn * max_rec);
+    inbox_buf   = (char *)memalign(64 * 1024, ppn * max_rec);
+    scatter_buf = (char *)memalign(64 * 1024, ppn * max_rec);
+    count = (int *) calloc(numnodes, sizeof(int));
+    pos   = (int *) malloc(sizeof(int) * numnodes);
+    peers = (int *) malloc(sizeof(int) * ppn);
+    reqs  = (MPI_Request *) malloc(sizeof(MPI_Request) * 2 * ppn);
+  }
+
+  // allocate the routing map.
+  int *map = (int *) malloc(sizeof(int) * numprocs);
+
+#if RANDOMNESS
+  sprintf(name, "xt4_agg_rnd_%d.dat", numprocs);
+#else
+  // Rank 0 makes up a routing map.
+  if(myrank == 0) {
+    build_random_map(1, numprocs, map);
+  }
+  // Broadcast the routing map.
+  MPI_Bcast(map, numprocs, MPI_INT, 0, MPI_COMM_WORLD);
+
+  sprintf(name, "xt4_agg_nn_%d.dat", numprocs);
+#endif
+
+  if(myrank == 0)
+    printf("Nodes %d ranks per node %d\n", numnodes, ppn);
+
+  for(msg_size=MAX_MSG_SIZE; msg_size>=MIN_MSG_SIZE; msg_size=(msg_size>>1)) {
+    for(i=0; i<11; i++)
+      time[i] = 0.0;
+
+    for(trial=0; trial<NUM_TRIALS; trial++) {
+
+#if RANDOMNESS
+      // Rank 0 makes up a routing map.
+      if(myrank == 0) {
+	build_random_map(trial == 0, numprocs, map);
+      }
+
+      // Broadcast the routing map.
+      MPI_Bcast(map, numprocs, MPI_INT, 0, MPI_COMM_WORLD);
+#endif
+
+      pe = map[myrank];
+
+      // warmup
+      direct_exchange(myrank, pe, msg_size, send_buf, recv_buf);
+      dtime = direct_exchange(myrank, pe, msg_size, send_buf, recv_buf);
+
+      // warmup
+      packed_exchange(myrank, pe, msg_size, send_buf, recv_buf);
+      ptime = packed_exchange(myrank, pe, msg_size, send_buf, recv_buf);
+
+      // warmup
+      delay = 0.0;
+      batches = 0;
+      aggregated_exchange(myrank, pe, msg_size, send_buf, recv_buf, &delay, &batches);
+      atime = aggregated_exchange(myrank, pe, msg_size, send_buf, recv_buf, &delay, &batches);
+
+      if(((int *) recv_buf)[0] != pe || ((int *) recv_buf)[1] != myrank) {
+	fprintf(stderr, "Rank %d received a record from %d for %d, expected %d\n",
+		myrank, ((int *) recv_buf)[0], ((int *) recv_buf)[1], pe);
+	MPI_Abort(MPI_COMM_WORLD, 1);
+      }
+
+      MPI_Allreduce(&dtime, &avg, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+      MPI_Allreduce(&dtime, &max, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+      time[0] += avg / numprocs;
+      time[1] += max;
+      time[6] += (double) numprocs * NUM_MSGS * msg_size / max;
+
+      MPI_Allreduce(&ptime, &avg, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+      MPI_Allreduce(&ptime, &max, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+      time[2] += avg / numprocs;
+      time[3] += max;
+      time[7] += (double) numprocs * NUM_MSGS * msg_size / max;
+
+      MPI_Allreduce(&atime, &avg, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+      MPI_Allreduce(&atime, &max, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+      time[4] += avg / numprocs;
+      time[5] += max;
+      time[8] += (double) numprocs * NUM_MSGS * msg_size / max;
+
+      // only the leaders have a delay and batches
+      MPI_Allreduce(&delay, &sum, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+      MPI_Allreduce(&batches, &nbatches, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+      time[9] += sum / numnodes;
+
+      // every rank whose partner is off-node is one record in some batch
+      if(myrank == 0) {
+	offnode = 0.0;
+	for(i = 0; i < numprocs; i++)
+	  if(nodeOf[i] != nodeOf[map[i]])
+	    offnode += 1.0;
+	time[10] += (nbatches > 0) ? offnode / nbatches : 0.0;
+      }
+    }
+
+    if(myrank == 0) {
+      FILE *outf = fopen(name, "a");
+      fprintf(outf, "%d", msg_size);
+      for(i=0; i<11; i++)
+	fprintf(outf, " %g", time[i]/NUM_TRIALS);
+      fprintf(outf, "\n");
+      fclose(outf);
+    }
+  }
+
+  if(myrank == 0)
+    printf("Program Complete\n");
+
+  MPI_Comm_free(&nodecomm);
+  if(noderank == 0)
+    MPI_Comm_free(&leadercomm);
+
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,168 @@
+/** \file commfit.c
+ *  Date Created: October 19th, 2026
+ *
+ *  COMMFIT:
+ *  --------------------------------------------------------------------------
+ *  Fits Hockney (alpha-beta) and LogGP parameters to the min/avg/max latency
+ *  files written by the benchmarks and prints one model entry per file, along
+ *  with the goodness-of-fit. This runs on the front-end, not under MPI.
+ *
+ *  Fitting:
+ *    commfit [-c min|avg|max] [-k contention] [-p pattern] [-d hops] file ...
+ *  -c and -k apply to all the files that follow them. -p and -d only apply
+ *  to the next file; when they are not given, the pattern and hop count are
+ *  taken from the file name, e.g. xt4_hops_4096_3.dat is pattern "hops" at
+ *  3 hops and xt4_nn_4096.dat is pattern "nn" at 0 hops.
+ *
+ *  Prediction:
+ *    commfit -m model [-p pattern] [-d hops] [-k contention] -s size
+ *  prints the estimated time (seconds) for a message of size bytes under
+ *  both models.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "commmodel.h"
+
+void usage(char *prog)
+{
+  fprintf(stderr, "Usage: %s [-c min|avg|max] [-k contention] [-p pattern] [-d hops] file ...\n", prog);
+  fprintf(stderr, "       %s -m model [-p pattern] [-d hops] [-k contention] -s size\n", prog);
+  exit(1);
+}
+
+int is_number(const char *s)
+{
+  if(*s == '\0')
+    return 0;
+  for(; *s != '\0'; s++)
+    if(!isdigit(*s))
+      return 0;
+  return 1;
+}
+
+/* Derives the pattern and hop count from names such as
+ * <machine>_<pattern>_<numprocs>[_<hops>].dat
+ */
+void parse_name(const char *file, char *pattern, int *hops)
+{
+  char buf[256], *tok, *base;
+  int field = 0, numbers = 0;
+
+  base = strrchr(file, '/');
+  strncpy(buf, base ? base + 1 : file, 255);
+  buf[255] = '\0';
+  if((tok = strstr(buf, ".dat")) != NULL)
+    *tok = '\0';
+
+  pattern[0] = '\0';
+  *hops = 0;
+  for(tok = strtok(buf, "_"); tok != NULL; tok = strtok(NULL, "_"), field++) {
+    if(is_number(tok)) {
+      // first number is the number of processors, the second the hops
+      if(numbers++ == 1)
+	*hops = atoi(tok);
+    } else if(field > 0 && numbers == 0) {
+      if(pattern[0] != '\0')
+	strncat(pattern, "_", CM_NAME_LEN - strlen(pattern) - 1);
+      strncat(pattern, tok, CM_NAME_LEN - strlen(pattern) - 1);
+    }
+  }
+
+  if(pattern[0] == '\0')
+    strcpy(pattern, "default");
+}
+
+int main(int argc, char *argv[]) {
+  int column = CM_COL_AVG, hops = -1, i, n;
+  double contention = 1.0, msg_size = -1.0;
+  char *pattern = NULL, *model = NULL;
+  double *sizes, *times;
+  cm_entry e;
+  cm_model m;
+  int header = 0, status = 0;
+
+  if(argc < 2)
+    usage(argv[0]);
+
+  for(i = 1; i < argc; i++) {
+    if(argv[i][0] == '-' && argv[i][1] != '\0' && argv[i][2] == '\0') {
+      if(i + 1 >= argc)
+	usage(argv[0]);
+      switch(argv[i][1]) {
+	case 'c':
+	  i++;
+	  if(strcmp(argv[i], "min") == 0)      column = CM_COL_MIN;
+	  else if(strcmp(argv[i], "avg") == 0) column = CM_COL_AVG;
+	  else if(strcmp(argv[i], "max") == 0) column = CM_COL_MAX;
+	  else usage(argv[0]);
+	  break;
+	case 'k': contention = atof(argv[++i]); break;
+	case 'p': pattern = argv[++i]; break;
+	case 'd': hops = atoi(argv[++i]); break;
+	case 'm': model = argv[++i]; break;
+	case 's': msg_size = atof(argv[++i]); break;
+	default:  usage(argv[0]);
+      }
+      continue;
+    }
+
+    if(model != NULL)
+      usage(argv[0]);
+
+    n = cm_read_dat(argv[i], column, &sizes, &times);
+    if(n < 0) {
+      status = 1;
+      continue;
+    }
+
+    memset(&e, 0, sizeof(cm_entry));
+    parse_name(argv[i], e.pattern, &e.hops);
+    if(pattern != NULL) {
+      strncpy(e.pattern, pattern, CM_NAME_LEN - 1);
+      e.pattern[CM_NAME_LEN - 1] = '\0';
+    }
+    if(hops >= 0)
+      e.hops = hops;
+    e.contention = contention;
+    pattern = NULL;
+    hops = -1;
+
+    if(cm_fit(n, sizes, times, &e) == 0) {
+      if(!header) {
+	cm_write_header(stdout);
+	header = 1;
+      }
+      cm_write_entry(stdout, &e);
+    } else {
+      fprintf(stderr, "Could not fit %s\n", argv[i]);
+      status = 1;
+    }
+    free(sizes);
+    free(times);
+  }
+
+  if(model != NULL) {
+    if(msg_size < 0.0 || cm_load(model, &m) <= 0)
+      usage(argv[0]);
+    if(hops < 0)
+      hops = 0;
+    // cm_predict can extrapolate below zero, so look for a match up front
+    for(i = 0, n = 0; i < m.num; i++)
+      if(pattern == NULL || strcmp(pattern, m.entries[i].pattern) == 0)
+	n++;
+    if(n == 0) {
+      fprintf(stderr, "No entry in %s for pattern %s\n", model,
+	      pattern != NULL ? pattern : "(any)");
+      status = 1;
+    } else
+      printf("%g %g %g\n", msg_size,
+	     cm_predict(&m, pattern, msg_size, hops, contention, CM_HOCKNEY),
+	     cm_predict(&m, pattern, msg_size, hops, contention, CM_LOGGP));
+    cm_free(&m);
+  }
+
+  return status;
+}
@@ -0,0 +1,342 @@
+/** \file commmodel.c
+ *  Date Created: October 19th, 2026
+ *
+ *  Fitting and prediction routines for the Hockney and LogGP models declared
+ *  in commmodel.h. Fits are weighted least squares with weights 1/T^2 so that
+ *  the relative error is minimized; an ordinary fit would be dominated by the
+ *  1 MB messages and say nothing about small message latency.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "commmodel.h"
+
+#define CM_MAX_LINE	1024
+
+// The LogGP fit is only split into eager and rendezvous segments if both have
+// CM_MIN_SEGMENT message sizes and the split leaves at most CM_MIN_GAIN of the
+// single segment error
+#define CM_MIN_SEGMENT	3
+#define CM_MIN_GAIN	0.5
+
+int cm_read_dat(const char *file, int column, double **sizes, double **times)
+{
+  FILE *inf = fopen(file, "r");
+  char line[CM_MAX_LINE];
+  double val[8];
+  int num = 0, max = 64, n;
+
+  if(inf == NULL) {
+    fprintf(stderr, "Could not open %s\n", file);
+    return -1;
+  }
+
+  *sizes = (double *) malloc(sizeof(double) * max);
+  *times = (double *) malloc(sizeof(double) * max);
+
+  while(fgets(line, CM_MAX_LINE, inf) != NULL) {
+    if(line[0] == '#')
+      continue;
+    n = sscanf(line, "%lf %lf %lf %lf %lf %lf %lf %lf", &val[0], &val[1],
+	       &val[2], &val[3], &val[4], &val[5], &val[6], &val[7]);
+    if(n < 2)
+      continue;
+
+    if(num == max) {
+      max *= 2;
+      *sizes = (double *) realloc(*sizes, sizeof(double) * max);
+      *times = (double *) realloc(*times, sizeof(double) * max);
+    }
+    (*sizes)[num] = val[0];
+    (*times)[num] = (n == 2) ? val[1] : val[(column < n) ? column : n-1];
+    if((*times)[num] > 0.0)
+      num++;
+  }
+  fclose(inf);
+
+  return num;
+}
+
+/* Sorts the points by message size (insertion sort, there are only a few
+ * dozen of them)
+ */
+static void sort_points(int n, double *x, double *y)
+{
+  int i, j;
+  double tx, ty;
+  for(i = 1; i < n; i++) {
+    tx = x[i];
+    ty = y[i];
+    for(j = i - 1; j >= 0 && x[j] > tx; j--) {
+      x[j+1] = x[j];
+      y[j+1] = y[j];
+    }
+    x[j+1] = tx;
+    y[j+1] = ty;
+  }
+}
+
+/* Weighted least squares fit of y = a + b * (x - shift) with weights 1/y^2.
+ * Returns the weighted sum of squared relative errors or -1 if the system is
+ * singular.
+ */
+static double wls(int n, double *x, double *y, double shift, double *a, double *b)
+{
+  double s = 0.0, sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+  double w, xi, det, r, err = 0.0;
+  int i;
+
+  for(i = 0; i < n; i++) {
+    w = 1.0 / (y[i] * y[i]);
+    xi = x[i] - shift;
+    s   += w;
+    sx  += w * xi;
+    sy  += w * y[i];
+    sxx += w * xi * xi;
+    sxy += w * xi * y[i];
+  }
+
+  det = s * sxx - sx * sx;
+  if(n < 2 || fabs(det) <= 1e-12 * s * sxx)
+    return -1.0;
+
+  *a = (sxx * sy - sx * sxy) / det;
+  *b = (s * sxy - sx * sy) / det;
+
+  for(i = 0; i < n; i++) {
+    r = (y[i] - *a - *b * (x[i] - shift)) / y[i];
+    err += r * r;
+  }
+  return err;
+}
+
+/* Coefficient of determination and maximum relative error of the model in e
+ */
+static void goodness(int n, double *x, double *y, const cm_entry *e, int which,
+		     double *r2, double *maxerr)
+{
+  double mean = 0.0, sstot = 0.0, ssres = 0.0, p, rel;
+  int i;
+
+  for(i = 0; i < n; i++)
+    mean += y[i];
+  mean /= n;
+
+  *maxerr = 0.0;
+  for(i = 0; i < n; i++) {
+    p = cm_eval(e, x[i], which);
+    sstot += (y[i] - mean) * (y[i] - mean);
+    ssres += (y[i] - p) * (y[i] - p);
+    rel = fabs(y[i] - p) / y[i];
+    if(rel > *maxerr) *maxerr = rel;
+  }
+  *r2 = (sstot > 0.0) ? 1.0 - ssres / sstot : 1.0;
+}
+
+int cm_fit(int npoints, double *sizes, double *times, cm_entry *e)
+{
+  double a, b, as, bs, al, bl, err, errs, errl, single, best = -1.0;
+  double l2o = 0.0, Ge = 0.0, G = 0.0, rdv = 0.0;
+  int i, k, below, bk = 0, distinct = 1;
+
+  sort_points(npoints, sizes, times);
+  for(i = 1; i < npoints; i++)
+    if(sizes[i] != sizes[i-1])
+      distinct++;
+
+  if(distinct < 2) {
+    fprintf(stderr, "Need at least two message sizes to fit a model\n");
+    return -1;
+  }
+  e->npoints = npoints;
+
+  // Hockney
+  wls(npoints, sizes, times, 0.0, &e->alpha, &e->beta);
+  goodness(npoints, sizes, times, e, CM_HOCKNEY, &e->r2, &e->maxerr);
+
+  // LogGP: a single segment unless splitting at some breakpoint, with at
+  // least CM_MIN_SEGMENT sizes on either side, costs extra on the large side
+  // (a rendezvous handshake) and cuts the error by CM_MIN_GAIN
+  single = wls(npoints, sizes, times, 1.0, &a, &b);
+  e->l2o = a;
+  e->Ge = e->G = b;
+  e->rdv = 0.0;
+  e->brk = sizes[npoints-1];
+
+  for(k = 1, below = 1; k < npoints; k++) {
+    // the breakpoint lies between sizes[k-1] and sizes[k]
+    if(sizes[k] == sizes[k-1])
+      continue;
+    if(below++ < CM_MIN_SEGMENT || distinct - below + 1 < CM_MIN_SEGMENT)
+      continue;
+    errs = wls(k, sizes, times, 1.0, &as, &bs);
+    errl = wls(npoints - k, sizes + k, times + k, 1.0, &al, &bl);
+    if(errs < 0.0 || errl < 0.0 || al - as <= 0.0)
+      continue;
+    err = errs + errl;
+    if(best < 0.0 || err < best) {
+      best = err;
+      bk = k;
+      l2o = as; Ge = bs; G = bl; rdv = al - as;
+    }
+  }
+
+  if(best >= 0.0 && best < CM_MIN_GAIN * single) {
+    e->l2o = l2o;
+    e->Ge = Ge;
+    e->G = G;
+    e->rdv = rdv;
+    e->brk = sizes[bk-1];
+  }
+  goodness(npoints, sizes, times, e, CM_LOGGP, &e->r2_loggp, &e->maxerr_loggp);
+
+  return 0;
+}
+
+void cm_write_header(FILE *outf)
+{
+  fprintf(outf, "# pattern hops contention npoints"
+	  " alpha beta r2 maxerr"
+	  " L+2o Ge G rdv brk r2_loggp maxerr_loggp\n");
+}
+
+void cm_write_entry(FILE *outf, const cm_entry *e)
+{
+  fprintf(outf, "%s %d %g %d %g %g %g %g %g %g %g %g %g %g %g\n",
+	  e->pattern, e->hops, e->contention, e->npoints,
+	  e->alpha, e->beta, e->r2, e->maxerr,
+	  e->l2o, e->Ge, e->G, e->rdv, e->brk, e->r2_loggp, e->maxerr_loggp);
+}
+
+int cm_load(const char *file, cm_model *m)
+{
+  FILE *inf = fopen(file, "r");
+  char line[CM_MAX_LINE];
+  int max = 16;
+  cm_entry *e;
+
+  m->num = 0;
+  m->entries = NULL;
+  if(inf == NULL) {
+    fprintf(stderr, "Could not open %s\n", file);
+    return -1;
+  }
+
+  m->entries = (cm_entry *) malloc(sizeof(cm_entry) * max);
+  while(fgets(line, CM_MAX_LINE, inf) != NULL) {
+    if(line[0] == '#' || line[0] == '\n')
+      continue;
+    if(m->num == max) {
+      max *= 2;
+      m->entries = (cm_entry *) realloc(m->entries, sizeof(cm_entry) * max);
+    }
+    e = &m->entries[m->num];
+    if(sscanf(line, "%63s %d %lf %d %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf",
+	      e->pattern, &e->hops, &e->contention, &e->npoints,
+	      &e->alpha, &e->beta, &e->r2, &e->maxerr,
+	      &e->l2o, &e->Ge, &e->G, &e->rdv, &e->brk,
+	      &e->r2_loggp, &e->maxerr_loggp) == 15)
+      m->num++;
+    else
+      fprintf(stderr, "Skipping malformed line in %s: %s", file, line);
+  }
+  fclose(inf);
+
+  return m->num;
+}
+
+void cm_free(cm_model *m)
+{
+  free(m->entries);
+  m->entries = NULL;
+  m->num = 0;
+}
+
+double cm_eval(const cm_entry *e, double msg_size, int which)
+{
+  if(which == CM_HOCKNEY)
+    return e->alpha + e->beta * msg_size;
+  if(msg_size <= e->brk)
+    return e->l2o + (msg_size - 1) * e->Ge;
+  return e->l2o + e->rdv + (msg_size - 1) * e->G;
+}
+
+/* Evaluates e with its bandwidth terms scaled from the fitted contention
+ * level to the requested one: k messages sharing a link each see 1/k of its
+ * bandwidth, the latency terms do not change.
+ */
+static double eval_scaled(const cm_entry *e, double msg_size, double contention,
+			  int which)
+{
+  cm_entry s = *e;
+  double k = (e->contention > 0.0 && contention > 0.0) ?
+    contention / e->contention : 1.0;
+
+  s.beta *= k;
+  s.Ge *= k;
+  s.G *= k;
+  return cm_eval(&s, msg_size, which);
+}
+
+double cm_predict(const cm_model *m, const char *pattern, double msg_size,
+		  int hops, double contention, int which)
+{
+  const cm_entry *e, *lo = NULL, *hi = NULL, *lo2 = NULL, *hi2 = NULL;
+  const cm_entry *e1, *e2;
+  double diff, best = -1.0, level = 0.0, t1, t2;
+  int i;
+
+  // nearest fitted contention level
+  for(i = 0; i < m->num; i++) {
+    e = &m->entries[i];
+    if(pattern != NULL && strcmp(pattern, e->pattern) != 0)
+      continue;
+    diff = fabs(e->contention - contention);
+    if(best < 0.0 || diff < best) {
+      best = diff;
+      level = e->contention;
+    }
+  }
+  if(best < 0.0)
+    return -1.0;
+
+  // closest hop counts below and above, and the next ones out in case we
+  // have to extrapolate
+  for(i = 0; i < m->num; i++) {
+    e = &m->entries[i];
+    if((pattern != NULL && strcmp(pattern, e->pattern) != 0) ||
+       e->contention != level)
+      continue;
+    if(e->hops <= hops) {
+      if(lo == NULL || e->hops > lo->hops) {
+	if(lo != NULL) lo2 = lo;
+	lo = e;
+      } else if(e->hops < lo->hops && (lo2 == NULL || e->hops > lo2->hops))
+	lo2 = e;
+    }
+    if(e->hops >= hops) {
+      if(hi == NULL || e->hops < hi->hops) {
+	if(hi != NULL) hi2 = hi;
+	hi = e;
+      } else if(e->hops > hi->hops && (hi2 == NULL || e->hops < hi2->hops))
+	hi2 = e;
+    }
+  }
+
+  if(lo != NULL && hi != NULL) {
+    e1 = lo; e2 = hi;
+  } else if(lo != NULL) {
+    e1 = lo2; e2 = lo;
+  } else {
+    e1 = hi; e2 = hi2;
+  }
+
+  if(e1 == NULL || e2 == NULL || e1->hops == e2->hops)
+    return eval_scaled(e1 != NULL ? e1 : e2, msg_size, contention, which);
+
+  t1 = eval_scaled(e1, msg_size, contention, which);
+  t2 = eval_scaled(e2, msg_size, contention, which);
+  return t1 + (t2 - t1) * (hops - e1->hops) / (double) (e2->hops - e1->hops);
+}
@@ -0,0 +1,92 @@
+/** \file commmodel.h
+ *  Date Created: October 19th, 2026
+ *
+ *  Communication models fitted to the output of the benchmarks in this suite
+ *  (xt4_nn_*.dat, xt4_hops_*.dat, xt4_line_*.dat, xt4_mode_*.dat, ...).
+ *
+ *  Two models are fitted for every (pattern, hops, contention) entry:
+ *    -- Hockney:  T(m) = alpha + beta * m
+ *    -- LogGP:    T(m) = L+2o + (m-1) * Ge                 for m <= brk
+ *                 T(m) = L+2o + rdv + (m-1) * G            for m >  brk
+ *  Ping-pong timings cannot separate L from o, so the two are reported as a
+ *  single L+2o term. brk is the eager/rendezvous switch found by the fit and
+ *  rdv is the extra handshake cost above it.
+ *
+ *  A fitted model is a plain text file with one entry per line which can be
+ *  loaded back with cm_load and queried with cm_predict.
+ */
+
+#ifndef _COMMMODEL_H_
+#define _COMMMODEL_H_
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CM_HOCKNEY	0
+#define CM_LOGGP	1
+
+// Columns in the min/avg/max files written by the benchmarks
+#define CM_COL_MIN	1
+#define CM_COL_AVG	2
+#define CM_COL_MAX	3
+
+#define CM_NAME_LEN	64
+
+typedef struct {
+  char pattern[CM_NAME_LEN];
+  int hops;
+  double contention;
+  int npoints;
+
+  // Hockney (alpha-beta)
+  double alpha, beta;
+  double r2, maxerr;
+
+  // LogGP
+  double l2o, Ge, G, rdv, brk;
+  double r2_loggp, maxerr_loggp;
+} cm_entry;
+
+typedef struct {
+  int num;
+  cm_entry *entries;
+} cm_model;
+
+/* Reads message sizes and times from a benchmark output file. Lines with
+ * only two numbers (such as xt4_latency_*.dat) use the second one regardless
+ * of column. Returns the number of points read or -1 on error.
+ */
+int cm_read_dat(const char *file, int column, double **sizes, double **times);
+
+/* Fits both models to npoints (size, time) pairs. Returns 0 on success and
+ * -1 if there are too few distinct message sizes.
+ */
+int cm_fit(int npoints, double *sizes, double *times, cm_entry *e);
+
+void cm_write_header(FILE *outf);
+void cm_write_entry(FILE *outf, const cm_entry *e);
+
+int cm_load(const char *file, cm_model *m);
+void cm_free(cm_model *m);
+
+/* Time for a single message of msg_size bytes under one model. */
+double cm_eval(const cm_entry *e, double msg_size, int which);
+
+/* Estimated time for a message of msg_size bytes travelling hops hops with
+ * a contention factor of contention (messages sharing the busiest link).
+ * Entries are restricted to pattern unless it is NULL, the nearest fitted
+ * contention level is used and its bandwidth term is scaled to the requested
+ * one, and the result is interpolated linearly in hops between the two
+ * closest fitted hop counts. Returns a negative value if no entry matches.
+ */
+double cm_predict(const cm_model *m, const char *pattern, double msg_size,
+		  int hops, double contention, int which);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _COMMMODEL_H_